@@ -29,17 +29,24 @@
 
 #include "drv_ludlum_m375.h"
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <vector>
+
 #include <errlog.h>
 #include <epicsExit.h>
 #include <epicsExport.h>
+#include <epicsMutex.h>
 #include <epicsString.h>
 #include <iocsh.h>
 
+#include <osiSock.h>
+
 #include <asynOctetSyncIO.h>
+#include <drvAsynIPPort.h>
 
 
 //==============================================================================
@@ -57,7 +64,7 @@
 
 //==============================================================================
 //
-static const char* driverVersion = "1.1.3";
+static const char* driverVersion = "1.5.0";
 
 // MUST be consistent with enum Qualifiers type out of Driverludlum_M375 (in drvludlum_M375.h)
 //
@@ -72,12 +79,34 @@ static const QualifierDefinitions qualifierList [DriverLudlumM375::NUMBER_QUALIF
    {asynParamOctet,     "DRIVER_VERSION"  },
    {asynParamFloat64,   "DOSE",           },
    {asynParamFloat64,   "DOSERATE",       },
-   {asynParamInt32,     "COUNT",          }
+   {asynParamInt32,     "COUNT",          },
+   {asynParamInt32,     "ALARM",          },
+   {asynParamInt32,     "ALARM_REASON",   },
+   {asynParamFloat64,   "ALARM_HIGH",     },
+   {asynParamFloat64,   "ALARM_HIHI",     },
+   {asynParamFloat64,   "ALARM_ROC",      },
+   {asynParamFloat64,   "ALARM_STEP",     },
+   {asynParamFloat64,   "ALARM_LATENCY",  },
+   {asynParamInt32Array,"ALARM_LATENCY_HIST" },
+   {asynParamFloat64,   "BACKGROUND",     },
+   {asynParamFloat64,   "BEAM_DOSERATE",  },
+   {asynParamFloat64,   "RATE_TREND",     },
+   {asynParamFloat64,   "FORECAST_TAU",   },
+   {asynParamFloat64,   "FORECAST_HORIZON"},
+   {asynParamFloat64,   "FORECAST_DOSE",  },
+   {asynParamFloat64,   "FORECAST_LONG_HORIZON"},
+   {asynParamFloat64,   "FORECAST_LONG_DOSE"},
+   {asynParamFloat64,   "SHIFT_DOSE",     },
+   {asynParamFloat64,   "SHIFT_BUDGET",   },
+   {asynParamFloat64,   "SHIFT_TTL",      },
+   {asynParamFloat64,   "ANNUAL_DOSE",    },
+   {asynParamFloat64,   "ANNUAL_BUDGET",  },
+   {asynParamFloat64,   "ANNUAL_TTL",     }
 };
 
 // Supported interrupts.
 //
-static const int interruptMask =  asynFloat64Mask;
+static const int interruptMask =  asynFloat64Mask | asynInt32Mask | asynInt32ArrayMask;
 
 // Any interrupt must also have an interface.
 //
@@ -97,6 +126,18 @@ static int LudlumM375Debug = 0;    // Errors only
 //
 static const double  maxValidAgeLimit = 7.0;
 
+// All successfully configured instances. Instances are only ever added, but
+// may be added after iocInit while the list is being read, hence the mutex.
+//
+static std::vector<DriverLudlumM375*> instanceList;
+static epicsMutex instanceListMutex;
+
+// Alarm severities - same values as the EPICS menuAlarmSevr values.
+//
+static const epicsInt32 alarmNone  = 0;
+static const epicsInt32 alarmMinor = 1;
+static const epicsInt32 alarmMajor = 2;
+
 
 //==============================================================================
 // Local functions
@@ -169,11 +210,36 @@ DriverLudlumM375::DriverLudlumM375 (const char* portNameIn,
    // Initialize as effectively 120 second old - this will cause an
    // immediate stale indication until data is actually read.
    //
-   this->lastReadTime = epicsTime::getCurrent () - 120.0;
+   this->createTime = epicsTime::getCurrent ();
+   this->firstSampleDelay = -1.0;
+   this->lastReadTime = this->createTime - 120.0;
    this->dose = 0.0;
    this->doseRate = 0.0;
    this->count = 0;
 
+   this->alarmHigh = 0.0;
+   this->alarmHiHi = 0.0;
+   this->alarmRateOfChange = 0.0;
+   this->alarmStep = 0.0;
+   this->alarmSeverity = alarmNone;
+   this->alarmReason = 0;
+   this->alarmLatency = 0.0;
+   for (int j = 0; j < NUMBER_LATENCY_BINS; j++) {
+      this->latencyHistogram [j] = 0;
+   }
+
+   this->background = 0.0;
+   this->forecastTau = 600.0;
+   this->forecastHorizon = 1.0;
+   this->forecastLongHorizon = 8.0;
+   this->beamDoseRate = 0.0;
+   this->rateLevel = 0.0;
+   this->rateTrend = 0.0;
+   this->shiftDose = 0.0;
+   this->shiftBudget = 0.0;
+   this->annualDose = 0.0;
+   this->annualBudget = 0.0;
+
    // Set up asyn parameters.
    //
    for (int j = 0; j < ARRAY_LENGTH (qualifierList); j++) {
@@ -218,6 +284,9 @@ DriverLudlumM375::DriverLudlumM375 (const char* portNameIn,
    // We got to the end - the port initialisation has been successful.
    //
    this->readyToGo = true;
+   instanceListMutex.lock ();
+   instanceList.push_back (this);
+   instanceListMutex.unlock ();
    INFO ("%s setup complete", this->portName);
 }
 
@@ -280,6 +349,14 @@ asynStatus DriverLudlumM375::readInt32 (asynUser* pasynUser, epicsInt32* value)
          *value = this->count;
          break;
 
+      case Alarm:
+         *value = this->alarmSeverity;
+         break;
+
+      case AlarmReason:
+         *value = this->alarmReason;
+         break;
+
       default:
          errlogPrintf ("%s: %s Unexpected qualifier (%s)\n", __FUNCTION__,
                        this->portName, this->qualifierImage (qualifier));
@@ -324,6 +401,40 @@ asynStatus DriverLudlumM375::readFloat64 (asynUser* pasynUser, epicsFloat64* val
          *value = epicsFloat64 (qualifier == Dose ? this->dose : this->doseRate);
          break;
 
+      case AlarmHigh:
+      case AlarmHiHi:
+      case AlarmRateOfChange:
+      case AlarmStep:
+      case Background:
+      case ForecastTau:
+      case ForecastHorizon:
+      case ForecastLongHorizon:
+      case ShiftDose:
+      case ShiftBudget:
+      case AnnualDose:
+      case AnnualBudget:
+         // Use the parameter library - this is undefined until first written,
+         // so the initial readback does not clobber the record's VAL field.
+         //
+         status = asynPortDriver::readFloat64 (pasynUser, value);
+         break;
+
+      case BeamDoseRate:
+      case RateTrend:
+      case ForecastDose:
+      case ForecastLongDose:
+      case ShiftTimeToLimit:
+      case AnnualTimeToLimit:
+         // Forecast outputs - as last calculated, undefined until the first
+         // valid sample.
+         //
+         status = asynPortDriver::readFloat64 (pasynUser, value);
+         break;
+
+      case AlarmLatency:
+         *value = this->alarmLatency;
+         break;
+
       default:
          errlogPrintf ("%s: %s Unexpected qualifier (%s)\n", __FUNCTION__,
                        this->portName, this->qualifierImage (qualifier));
@@ -362,6 +473,56 @@ asynStatus DriverLudlumM375::writeFloat64 (asynUser *pasynUser, epicsFloat64 val
          this->callParamCallbacks ();
          break;
 
+      case AlarmHigh:
+      case AlarmHiHi:
+      case AlarmRateOfChange:
+      case AlarmStep:
+         // Alarm thresholds - applied to the next sample.
+         //
+         switch (qualifier) {
+            case AlarmHigh:          this->alarmHigh = value;          break;
+            case AlarmHiHi:          this->alarmHiHi = value;          break;
+            case AlarmRateOfChange:  this->alarmRateOfChange = value;  break;
+            default:                 this->alarmStep = value;          break;
+         }
+         this->setDoubleParam (qualifier, value);
+         this->callParamCallbacks ();
+         break;
+
+      case ShiftDose:
+      case AnnualDose:
+         // Re-set the accumulated beam dose - new shift/year or auto saved value.
+         //
+         if (qualifier == ShiftDose) {
+            this->shiftDose = value;
+         } else {
+            this->annualDose = value;
+         }
+         this->setDoubleParam (qualifier, value);
+         this->setParamStatus (qualifier, asynSuccess);
+         this->callParamCallbacks ();
+         break;
+
+      case Background:
+      case ForecastTau:
+      case ForecastHorizon:
+      case ForecastLongHorizon:
+      case ShiftBudget:
+      case AnnualBudget:
+         // Forecast configuration - applied to the next sample.
+         //
+         switch (qualifier) {
+            case Background:           this->background = value;           break;
+            case ForecastTau:          this->forecastTau = value;          break;
+            case ForecastHorizon:      this->forecastHorizon = value;      break;
+            case ForecastLongHorizon:  this->forecastLongHorizon = value;  break;
+            case ShiftBudget:          this->shiftBudget = value;          break;
+            default:                   this->annualBudget = value;         break;
+         }
+         this->setDoubleParam (qualifier, value);
+         this->callParamCallbacks ();
+         break;
+
       default:
          errlogPrintf ("%s: %s Unexpected qualifier (%s)\n", __FUNCTION__,
                       this->portName, this->qualifierImage (qualifier));
@@ -374,12 +535,134 @@ asynStatus DriverLudlumM375::writeFloat64 (asynUser *pasynUser, epicsFloat64 val
 
 //------------------------------------------------------------------------------
 //
-asynStatus DriverLudlumM375::readDeviceData (double& doseRate)
+asynStatus DriverLudlumM375::readInt32Array (asynUser* pasynUser, epicsInt32* value,
+                                             size_t nElements, size_t* nIn)
+{
+   const Qualifiers qualifier = this->getQualifier (pasynUser);
+
+   asynStatus status = asynError;
+   size_t n;
+
+   // Did we successfully initialise?
+   //
+   ASSERT_INITIALISED;
+
+   status = asynSuccess;        // hypothesize okay
+
+   switch (qualifier) {
+
+      case AlarmLatencyHist:
+         n = MIN (nElements, (size_t) NUMBER_LATENCY_BINS);
+         memcpy (value, this->latencyHistogram, n * sizeof (epicsInt32));
+         *nIn = n;
+         break;
+
+      default:
+         errlogPrintf ("%s: %s Unexpected qualifier (%s)\n", __FUNCTION__,
+                       this->portName, this->qualifierImage (qualifier));
+         status = asynError;
+         break;
+   }
+
+   return status;
+}
+
+//------------------------------------------------------------------------------
+//
+void DriverLudlumM375::report (FILE* fp, int details)
+{
+   const double age = epicsTime::getCurrent () - this->createTime;
+
+   fprintf (fp, "DriverLudlumM375 %s (server port %s)\n", this->portName, this->serverPort);
+   fprintf (fp, "  created: %.3f s ago  first valid sample: ", age);
+   if (this->firstSampleDelay >= 0.0) {
+      fprintf (fp, "%.3f s after creation\n", this->firstSampleDelay);
+   } else {
+      fprintf (fp, "none yet\n");
+   }
+   fprintf (fp, "  count: %d  dose rate: %.3f uSv/Hr  dose: %.3f uSv  alarm: %d (0x%04x)\n",
+            this->count, this->doseRate, this->dose, this->alarmSeverity, this->alarmReason);
+
+   if (details > 0) {
+      asynPortDriver::report (fp, details);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+bool DriverLudlumM375::isReady () const
+{
+   return this->readyToGo;
+}
+
+//------------------------------------------------------------------------------
+//
+void DriverLudlumM375::getSnapshot (Snapshot& snapshot)
+{
+   this->lock ();
+
+   snapshot.dose = this->dose;
+   snapshot.doseRate = this->doseRate;
+   snapshot.count = this->count;
+   snapshot.alarmSeverity = this->alarmSeverity;
+   snapshot.alarmReason = this->alarmReason;
+   snapshot.readTime = this->lastReadTime;
+   snapshot.isValid = (epicsTime::getCurrent () - this->lastReadTime) < maxValidAgeLimit;
+   snapshot.hasSample = (this->firstSampleDelay >= 0.0);
+
+   this->unlock ();
+}
+
+//------------------------------------------------------------------------------
+// static
+int DriverLudlumM375::numberOfInstances ()
+{
+   instanceListMutex.lock ();
+   const int result = (int) instanceList.size ();
+   instanceListMutex.unlock ();
+   return result;
+}
+
+//------------------------------------------------------------------------------
+// static
+DriverLudlumM375* DriverLudlumM375::getInstance (const int index)
+{
+   DriverLudlumM375* result = NULL;
+
+   instanceListMutex.lock ();
+   if ((index >= 0) && (index < (int) instanceList.size ())) {
+      result = instanceList [index];
+   }
+   instanceListMutex.unlock ();
+   return result;
+}
+
+//------------------------------------------------------------------------------
+// Extracts a 0/1 flag value from <tag>n</tag> within the given text.
+// Returns -1 if the tag is missing or the value malformed.
+//
+static int extractFlag (const char* text, const char* tag)
+{
+   const char* item = strstr (text, tag);
+   if (!item) return -1;
+
+   int flag;
+   int n = sscanf (item + strlen (tag), "%d", &flag);
+   if (n != 1) return -1;
+
+   return flag;
+}
+
+//------------------------------------------------------------------------------
+//
+asynStatus DriverLudlumM375::readDeviceData (double& doseRate, int& deviceFlags,
+                                              epicsTime& frameTime)
 {
    static const size_t minimumResponseLength = 60;
    static const double timeout = 10.0;
 
    doseRate = 0.0;   // ensure not erroneous
+   deviceFlags = 0;
 
    char responseBuffer [420];   // Large enough for any valid message 384 bytes.
    size_t nbytesIn;
@@ -391,6 +674,11 @@ asynStatus DriverLudlumM375::readDeviceData (double& doseRate)
           responseBuffer, sizeof (responseBuffer) - 1,
           timeout, &nbytesIn, &eomReason);
 
+   // Frame arrival time - taken before any decoding, also used for the read
+   // failure age check.
+   //
+   frameTime = epicsTime::getCurrent ();
+
    ASSERT (status == asynSuccess, "[%s] read failure", this->portName);
 
    // Check size of response - this shoud be at least xxx bytes.
@@ -423,6 +711,15 @@ asynStatus DriverLudlumM375::readDeviceData (double& doseRate)
       input = tags [j];
    }
 
+   // The device alarm flags follow the rate, and are within the status
+   // element. Extract these before we zero terminate the rate value.
+   // These are informational, so missing flags are not an error.
+   //
+   *tags [4] = '\0';
+   if (extractFlag (tags [3], "<alarm1>") == 1)     deviceFlags |= ReasonDeviceAlarm1;
+   if (extractFlag (tags [3], "<alarm2>") == 1)     deviceFlags |= ReasonDeviceAlarm2;
+   if (extractFlag (tags [3], "<over_range>") == 1) deviceFlags |= ReasonOverRange;
+
    // Value is between 2nd and 3rd (ZERO based) tags, zero terminate value.
    //
    char* value = tags [2] + strlen (tagNames [2]);
@@ -449,21 +746,31 @@ void DriverLudlumM375::threadFunction ()
    while (!this->shutdownRequested) {
 
       double tempDoseRate;
+      int tempDeviceFlags;
+      epicsTime timeNow;    // frame arrival time
 
-      const asynStatus status = this->readDeviceData (tempDoseRate);
-      const epicsTime timeNow = epicsTime::getCurrent();
+      const asynStatus status = this->readDeviceData (tempDoseRate, tempDeviceFlags, timeNow);
       if (this->shutdownRequested) break;
 
+      this->lock ();
+
       if (status == asynSuccess) {
 
-         // The value has been read and extracted
+         // The value has been read and extracted.
+         // Evaluate the alarm state first, and post it ahead of everything
+         // else so as to minimise the alarm latency. A negative interval
+         // indicates there is no previous sample to compare with.
          //
+         const double interval = firstTime ? -1.0 : timeNow - this->lastReadTime;
+         this->evaluateAlarm (tempDoseRate, interval, tempDeviceFlags);
+         this->callParamCallbacks ();
+         this->recordLatency (timeNow);
+
          // On 2nd and subsequent input, we can start integtating the
          // dose rate to calculate a dose. Note: we use the previous does rate
          // here - it is the value in affect until we know better.
          //
          if (!firstTime) {
-            const double interval = timeNow - this->lastReadTime;
             this->dose += this->doseRate * (interval / 3600.0);
          } else {
             firstTime = false;
@@ -473,6 +780,14 @@ void DriverLudlumM375::threadFunction ()
          this->lastReadTime = timeNow;
          this->count = (this->count + 1) % 100000;
 
+         this->updateForecast (interval);
+
+         if (this->firstSampleDelay < 0.0) {
+            this->firstSampleDelay = timeNow - this->createTime;
+            printf ("DriverLUDLUM_M375 %s first valid sample after %.3f s\n",
+                    this->portName, this->firstSampleDelay);
+         }
+
          // I/O interrupt
          //
          this->setDoubleParam (Dose, this->dose);
@@ -481,7 +796,12 @@ void DriverLudlumM375::threadFunction ()
          this->setDoubleParam (DoseRate, this->doseRate);
          this->setParamStatus (DoseRate, asynSuccess);
 
+         this->setDoubleParam (AlarmLatency, this->alarmLatency);
+         this->doCallbacksInt32Array (this->latencyHistogram, NUMBER_LATENCY_BINS,
+                                      AlarmLatencyHist, 0);
+
          this->callParamCallbacks ();
+         this->unlock ();
 
          DETAIL ("[%s] dose rate: %.3f uSv/Hr  dose: %.3f uSv",
                  this->portName, this->doseRate, this->dose);
@@ -494,9 +814,18 @@ void DriverLudlumM375::threadFunction ()
          if (theAge >= maxValidAgeLimit) {
             this->setParamStatus (DoseRate, status);
             this->setParamStatus (Dose, status);
+            this->setParamStatus (Alarm, status);
+            this->setParamStatus (AlarmReason, status);
+            this->setParamStatus (BeamDoseRate, status);
+            this->setParamStatus (RateTrend, status);
+            this->setParamStatus (ForecastDose, status);
+            this->setParamStatus (ForecastLongDose, status);
+            this->setParamStatus (ShiftTimeToLimit, status);
+            this->setParamStatus (AnnualTimeToLimit, status);
             this->callParamCallbacks ();
             firstTime = true;  // restart integration
          }
+         this->unlock ();
 
          epicsThreadSleep (1.0);
       }
@@ -505,6 +834,175 @@ void DriverLudlumM375::threadFunction ()
    printf ("DriverLUDLUM_M375 thread complete\n");
 }
 
+//------------------------------------------------------------------------------
+// Applies the thresholds, rate of change and step detection and the device's
+// own alarm flags to a newly parsed sample, and sets the alarm parameters.
+// Only rising changes are considered an excursion.
+//
+void DriverLudlumM375::evaluateAlarm (const double newDoseRate,
+                                      const double interval,
+                                      const int deviceFlags)
+{
+   epicsInt32 severity = alarmNone;
+   epicsInt32 reason = deviceFlags;
+
+   if ((this->alarmHiHi > 0.0) && (newDoseRate >= this->alarmHiHi)) {
+      reason |= ReasonHiHi;
+   }
+
+   if ((this->alarmHigh > 0.0) && (newDoseRate >= this->alarmHigh)) {
+      reason |= ReasonHigh;
+   }
+
+   if (interval >= 0.0) {
+      const double change = newDoseRate - this->doseRate;
+
+      if ((this->alarmStep > 0.0) && (change >= this->alarmStep)) {
+         reason |= ReasonStep;
+      }
+
+      // Guard against silly small intervals.
+      //
+      if ((this->alarmRateOfChange > 0.0) &&
+          (change / MAX (interval, 0.1) >= this->alarmRateOfChange)) {
+         reason |= ReasonRateOfChange;
+      }
+   }
+
+   if (reason & (ReasonHiHi | ReasonDeviceAlarm2 | ReasonOverRange)) {
+      severity = alarmMajor;
+   } else if (reason != 0) {
+      severity = alarmMinor;
+   }
+
+   if ((severity != this->alarmSeverity) || (reason != this->alarmReason)) {
+      INFO ("[%s] alarm severity: %d  reason: 0x%04x  rate: %.3f uSv/Hr",
+            this->portName, severity, reason, newDoseRate);
+   }
+
+   this->alarmSeverity = severity;
+   this->alarmReason = reason;
+
+   this->setIntegerParam (Alarm, this->alarmSeverity);
+   this->setParamStatus (Alarm, asynSuccess);
+   this->setIntegerParam (AlarmReason, this->alarmReason);
+   this->setParamStatus (AlarmReason, asynSuccess);
+}
+
+//------------------------------------------------------------------------------
+// Records the time from frame arrival until the alarm has been posted.
+//
+void DriverLudlumM375::recordLatency (const epicsTime& frameTime)
+{
+   const double latency = (epicsTime::getCurrent () - frameTime) * 1.0e6;   // uS
+
+   int bin = 0;
+   for (double upper = 2.0; bin < NUMBER_LATENCY_BINS - 1; bin++, upper *= 2.0) {
+      if (latency < upper) break;
+   }
+
+   this->alarmLatency = latency;
+   this->latencyHistogram [bin]++;
+}
+
+//------------------------------------------------------------------------------
+// Integral over [0, horizon] hours of max (0, level + trend*t), i.e. the
+// projected dose for a linearly extrapolated dose rate that cannot go negative.
+//
+static double projectedDose (const double level, const double trend, const double horizon)
+{
+   double from = 0.0;
+   double to = horizon;
+
+   if (trend > 0.0) {
+      from = LIMIT (-level / trend, 0.0, horizon);   // rate positive after
+   } else if (trend < 0.0) {
+      to = LIMIT (-level / trend, 0.0, horizon);     // rate positive before
+   } else if (level <= 0.0) {
+      return 0.0;
+   }
+
+   if (to <= from) return 0.0;
+   return level * (to - from) + 0.5 * trend * (to * to - from * from);
+}
+
+//------------------------------------------------------------------------------
+// Hours until budget reached at the given rate, 0 if already reached and -1
+// if never reached or the budget is disabled.
+//
+static double timeToLimit (const double dose, const double budget, const double rate)
+{
+   if (budget <= 0.0) return -1.0;
+   if (dose >= budget) return 0.0;
+   if (rate <= 0.0) return -1.0;
+   return (budget - dose) / rate;
+}
+
+//------------------------------------------------------------------------------
+// Updates the dose budget forecast with the new dose rate sample. This is O(1)
+// per sample. A negative interval indicates there is no previous sample, and
+// the trend is (re)started. A zero interval (frames delivered back to back
+// with the same time stamp) leaves the accumulated doses and trend as is.
+//
+void DriverLudlumM375::updateForecast (const double interval)
+{
+   // Separate beam induced dose rate from the background (in uSv/day).
+   //
+   const double beamRate = MAX (0.0, this->doseRate - this->background / 24.0);
+
+   if (interval < 0.0) {
+      this->rateLevel = beamRate;
+      this->rateTrend = 0.0;
+
+   } else if (interval > 0.0) {
+      const double hours = interval / 3600.0;
+
+      // As per dose, use the previous beam dose rate.
+      //
+      this->shiftDose += this->beamDoseRate * hours;
+      this->annualDose += this->beamDoseRate * hours;
+
+      // Holt's linear trend, with the weight adjusted for the actual interval.
+      //
+      const double alpha = 1.0 - exp (-interval / MAX (this->forecastTau, 1.0));
+      const double previousLevel = this->rateLevel;
+      const double predicted = this->rateLevel + this->rateTrend * hours;
+
+      this->rateLevel = predicted + alpha * (beamRate - predicted);
+      this->rateTrend += alpha * ((this->rateLevel - previousLevel) / hours - this->rateTrend);
+   }
+
+   this->beamDoseRate = beamRate;
+
+   // Time to limit is at the current smoothed rate - the trend is not
+   // extrapolated out to shift or annual time scales.
+   //
+   const double horizon = MAX (this->forecastHorizon, 0.0);
+   const double forecast = projectedDose (this->rateLevel, this->rateTrend, horizon);
+   const double longHorizon = MAX (this->forecastLongHorizon, 0.0);
+   const double longForecast = projectedDose (this->rateLevel, this->rateTrend, longHorizon);
+   const double shiftTtl = timeToLimit (this->shiftDose, this->shiftBudget, this->rateLevel);
+   const double annualTtl = timeToLimit (this->annualDose, this->annualBudget, this->rateLevel);
+
+   static const Qualifiers outputs [] = {
+      BeamDoseRate, RateTrend, ForecastDose, ForecastLongDose, ShiftDose,
+      ShiftTimeToLimit, AnnualDose, AnnualTimeToLimit
+   };
+
+   this->setDoubleParam (BeamDoseRate, this->beamDoseRate);
+   this->setDoubleParam (RateTrend, this->rateTrend);
+   this->setDoubleParam (ForecastDose, forecast);
+   this->setDoubleParam (ForecastLongDose, longForecast);
+   this->setDoubleParam (ShiftDose, this->shiftDose);
+   this->setDoubleParam (ShiftTimeToLimit, shiftTtl);
+   this->setDoubleParam (AnnualDose, this->annualDose);
+   this->setDoubleParam (AnnualTimeToLimit, annualTtl);
+
+   for (int j = 0; j < ARRAY_LENGTH (outputs); j++) {
+      this->setParamStatus (outputs [j], asynSuccess);
+   }
+}
+
 //------------------------------------------------------------------------------
 //
 void DriverLudlumM375::shutdown ()
@@ -614,12 +1112,144 @@ static void callLudlumM375Configure (const iocshArgBuf* args)
    new DriverLudlumM375 (args[0].sval, args[1].sval);
 }
 
+//------------------------------------------------------------------------------
+//
+static const iocshArg MapConfigureArg0 = { "Map file name", iocshArgString };
+static const iocshArg MapConfigureArg1 = { "Asyn port name prefix", iocshArgString };
+static const iocshArg MapConfigureArg2 = { "IOC host name override", iocshArgString };
+
+static const iocshArg *const LudlumM375MapConfigureArgs[3] = {
+   &MapConfigureArg0,
+   &MapConfigureArg1,
+   &MapConfigureArg2
+};
+
+static const iocshFuncDef LudlumM375MapConfigureFuncDef = {
+   "Ludlum_M375_MapConfigure", 3, LudlumM375MapConfigureArgs
+};
+
+//------------------------------------------------------------------------------
+// Reads a map file, same format as used by ludlum_m375_manage, i.e.
+//
+//    ioc_host ioc_port  m375_host m375_port
+//
+// Each line configures a ludlum_m375_c2c relay, which listens on both the
+// ioc_host:ioc_port and m375_host:m375_port addresses. The IOC is a client
+// of the relay, so for each map line this creates an IP client port
+// <prefix><ioc_port>_CLIENT connecting to ioc_host:ioc_port (or the override
+// host if specified) together with a driver instance named <prefix><ioc_port>.
+// As per ludlum_m375_c2c, a host name of "host" means the local host name.
+// Each driver's device setup runs on its own thread, so all devices come up
+// concurrently once the IOC is running.
+//
+static void callLudlumM375MapConfigure (const iocshArgBuf* args)
+{
+   const char* mapFile = args[0].sval;
+   const char* prefix = args[1].sval;
+   const char* hostOverride = args[2].sval;
+
+   if ((mapFile == NULL) || (strlen (mapFile) == 0)) {
+      errlogPrintf ("Ludlum_M375_MapConfigure: Null/empty map file name\n");
+      return;
+   }
+
+   if ((prefix == NULL) || (strlen (prefix) == 0)) {
+      prefix = "M375_";
+   }
+
+   char localHost [80];
+   if (gethostname (localHost, sizeof (localHost)) != 0) {
+      snprintf (localHost, sizeof (localHost), "localhost");
+   }
+   localHost [sizeof (localHost) - 1] = '\0';
+
+   FILE* input = fopen (mapFile, "r");
+   if (!input) {
+      errlogPrintf ("Ludlum_M375_MapConfigure: cannot open map file %s\n", mapFile);
+      return;
+   }
+
+   const epicsTime startTime = epicsTime::getCurrent ();
+   int lineNo = 0;
+   int okay = 0;
+   int failed = 0;
+   char line [200];
+
+   while (fgets (line, sizeof (line), input)) {
+      lineNo++;
+
+      // Skip comment and blank lines.
+      //
+      char* item = line;
+      while ((*item == ' ') || (*item == '\t')) item++;
+      if ((*item == '#') || (*item == '\n') || (*item == '\r') || (*item == '\0')) continue;
+
+      char iocHost [80];
+      char m375Host [80];
+      int iocPort;
+      int m375Port;
+
+      int n = sscanf (item, "%79s %d %79s %d", iocHost, &iocPort, m375Host, &m375Port);
+      if (n != 4) {
+         errlogPrintf ("Ludlum_M375_MapConfigure: %s:%d malformed map line\n",
+                       mapFile, lineNo);
+         failed++;
+         continue;
+      }
+
+      const char* host = iocHost;
+      if (hostOverride && strlen (hostOverride) > 0) {
+         host = hostOverride;
+      } else if (strcmp (iocHost, "host") == 0) {
+         host = localHost;
+      }
+
+      char portName [80];
+      char clientPortName [100];
+      char hostInfo [120];
+
+      snprintf (portName, sizeof (portName), "%s%d", prefix, iocPort);
+      snprintf (clientPortName, sizeof (clientPortName), "%s_CLIENT", portName);
+      snprintf (hostInfo, sizeof (hostInfo), "%s:%d", host, iocPort);
+
+      // Default priority, auto connect, and as per the server ports used in
+      // the example st.cmd file, noProcessEos must be set true.
+      //
+      int status = drvAsynIPPortConfigure (clientPortName, hostInfo, 0, 0, 1);
+      if (status != 0) {
+         errlogPrintf ("Ludlum_M375_MapConfigure: %s:%d cannot create client port %s (%s)\n",
+                       mapFile, lineNo, clientPortName, hostInfo);
+         failed++;
+         continue;
+      }
+
+      DriverLudlumM375* driver = new DriverLudlumM375 (portName, clientPortName);
+      if (!driver->isReady ()) {
+         errlogPrintf ("Ludlum_M375_MapConfigure: %s:%d cannot create driver %s\n",
+                       mapFile, lineNo, portName);
+         failed++;
+         continue;
+      }
+
+      printf ("Ludlum_M375_MapConfigure: %s -> %s via %s (relay for %s:%d)\n",
+              portName, clientPortName, hostInfo, m375Host, m375Port);
+      okay++;
+   }
+
+   fclose (input);
+
+   const double elapsed = epicsTime::getCurrent () - startTime;
+   printf ("Ludlum_M375_MapConfigure: %d port(s) configured, %d failed, in %.3f s\n",
+           okay, failed, elapsed);
+}
+
 //------------------------------------------------------------------------------
 //
 static void LudlumM375Startup (void)
 {
    printf ("DriverLudlumM375 startup version %s\n", driverVersion);
    iocshRegister (&LudlumM375ConfigureFuncDef, callLudlumM375Configure);
+   iocshRegister (&LudlumM375MapConfigureFuncDef, callLudlumM375MapConfigure);
 }
 
 
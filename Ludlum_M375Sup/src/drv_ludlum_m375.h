@@ -48,8 +48,45 @@ public:
                      Dose,                 // accum. dose ai uSv
                      DoseRate,             // dose ai uSv/Hr
                      Count,                // update count from mM375
+                     Alarm,                // alarm severity 0 .. 2 - I/O Intr
+                     AlarmReason,          // alarm reason bit set, see below
+                     AlarmHigh,            // minor dose rate threshold uSv/Hr
+                     AlarmHiHi,            // major dose rate threshold uSv/Hr
+                     AlarmRateOfChange,    // rate of change threshold uSv/Hr/s
+                     AlarmStep,            // single sample step threshold uSv/Hr
+                     AlarmLatency,         // frame arrival to alarm post uS
+                     AlarmLatencyHist,     // latency histogram counts
+                     Background,           // estimated background uSv/day
+                     BeamDoseRate,         // dose rate less background uSv/Hr
+                     RateTrend,            // smoothed beam dose rate trend uSv/Hr/Hr
+                     ForecastTau,          // smoothing time constant seconds
+                     ForecastHorizon,      // short forecast horizon hours
+                     ForecastDose,         // projected beam dose over horizon uSv
+                     ForecastLongHorizon,  // long (e.g. shift) forecast horizon hours
+                     ForecastLongDose,     // projected beam dose over long horizon uSv
+                     ShiftDose,            // accum. beam dose this shift uSv
+                     ShiftBudget,          // shift beam dose budget uSv
+                     ShiftTimeToLimit,     // hours until shift budget reached
+                     AnnualDose,           // accum. beam dose this year uSv
+                     AnnualBudget,         // annual beam dose budget uSv
+                     AnnualTimeToLimit,    // hours until annual budget reached
                      NUMBER_QUALIFIERS };  // must be last
 
+   // Alarm reason bits, as reported by the ALARM_REASON parameter.
+   //
+   enum AlarmReasons { ReasonHigh         = 0x0001,
+                       ReasonHiHi         = 0x0002,
+                       ReasonRateOfChange = 0x0004,
+                       ReasonStep         = 0x0008,
+                       ReasonDeviceAlarm1 = 0x0010,
+                       ReasonDeviceAlarm2 = 0x0020,
+                       ReasonOverRange    = 0x0040 };
+
+   // Latency histogram bin k counts latencies in the range [2^k, 2^(k+1)) uS,
+   // bin 0 includes anything below 2 uS, last bin includes anything above.
+   //
+   enum { NUMBER_LATENCY_BINS = 24 };
+
    // Overide asynPortDriver functions needed for this driver.
    //
    asynStatus readOctet (asynUser* pasynUser, char* value, size_t maxChars,
@@ -60,6 +97,36 @@ public:
    asynStatus readFloat64 (asynUser* pasynUser, epicsFloat64* value);
    asynStatus writeFloat64(asynUser* pasynUser, epicsFloat64 value);
 
+   asynStatus readInt32Array (asynUser* pasynUser, epicsInt32* value,
+                              size_t nElements, size_t* nIn);
+
+   void report (FILE* fp, int details);
+
+   // True if and only if the constructor completed successfully.
+   //
+   bool isReady () const;
+
+   // A consistent snapshot of the device state, used by the optional pvAccess
+   // table publisher.
+   //
+   struct Snapshot {
+      double dose;               // uSv
+      double doseRate;           // uSv/Hr
+      epicsInt32 count;
+      epicsInt32 alarmSeverity;
+      epicsInt32 alarmReason;
+      epicsTimeStamp readTime;
+      bool isValid;              // false when the values are stale
+      bool hasSample;            // false until the first valid sample
+   };
+
+   void getSnapshot (Snapshot& snapshot);
+
+   // Access to all successfully configured instances.
+   //
+   static int numberOfInstances ();
+   static DriverLudlumM375* getInstance (const int index);
+
 private:
    const int objectCheck;     // magic number
    const char* const serverPort;
@@ -79,7 +146,44 @@ private:
    epicsTime lastReadTime;
    epicsInt32 count;
 
-   asynStatus readDeviceData (double &doseRate);
+   // Startup metrics.
+   //
+   epicsTime createTime;
+   double firstSampleDelay;   // seconds from creation, negative until known
+
+   // Alarm evaluation state.
+   //
+   double alarmHigh;         // all thresholds: zero (or less) means disabled
+   double alarmHiHi;
+   double alarmRateOfChange;
+   double alarmStep;
+   epicsInt32 alarmSeverity;
+   epicsInt32 alarmReason;
+   double alarmLatency;
+   epicsInt32 latencyHistogram [NUMBER_LATENCY_BINS];
+
+   // Dose budget forecast state. Budgets of zero (or less) mean disabled.
+   // The rate level and trend are maintained as an exponentially weighted
+   // (Holt) linear trend of the beam dose rate.
+   //
+   double background;        // uSv/day
+   double forecastTau;       // seconds
+   double forecastHorizon;   // hours
+   double forecastLongHorizon;
+   double beamDoseRate;      // uSv/Hr
+   double rateLevel;         // uSv/Hr
+   double rateTrend;         // uSv/Hr/Hr
+   double shiftDose;
+   double shiftBudget;
+   double annualDose;
+   double annualBudget;
+
+   asynStatus readDeviceData (double &doseRate, int& deviceFlags,
+                              epicsTime& frameTime);
+   void evaluateAlarm (const double newDoseRate, const double interval,
+                       const int deviceFlags);
+   void recordLatency (const epicsTime& frameTime);
+   void updateForecast (const double interval);
    void threadFunction ();
    void shutdown ();
 
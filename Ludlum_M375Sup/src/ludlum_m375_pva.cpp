@@ -0,0 +1,436 @@
+// Description
+// Optional pvAccess publisher for the Ludlum M375 driver. This publishes the
+// state of all configured DriverLudlumM375 instances as a single NTTable PV,
+// one row per monitor, served by the IOC's PVXS server.
+//
+// A row is only refreshed when its dose or dose rate moves by more than the
+// deadband (as per the MDEL of the corresponding records) or its alarm state
+// changes; otherwise the row keeps its previously posted values, including
+// the count and time stamp. Each update then only marks the columns that have
+// changed, so subscribers only receive the changed fields.
+// Note: the NTTable granularity is the column, so when any row is refreshed
+// the whole dose, dose rate, count and time stamp columns are sent.
+//
+// Copyright (c) 2026 Australian Synchrotron
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// Licence as published by the Free Software Foundation; either
+// version 2.1 of the Licence, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public Licence for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// Licence along with this library; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Contact details:
+// andrews@ansto.gov.au
+// 800 Blackburn Road, Clayton, Victoria 3168, Australia.
+//
+
+#include "drv_ludlum_m375.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include <errlog.h>
+#include <epicsExit.h>
+#include <epicsExport.h>
+#include <epicsString.h>
+#include <epicsThread.h>
+#include <initHooks.h>
+#include <iocsh.h>
+
+#include <pvxs/iochooks.h>
+#include <pvxs/nt.h>
+#include <pvxs/server.h>
+#include <pvxs/sharedpv.h>
+
+using pvxs::shared_array;
+using pvxs::TypeCode;
+using pvxs::Value;
+
+#define ABS(a)             ((a) >= 0  ? (a) : -(a))
+
+// Alarm status values as per the normative types alarm_t status field.
+//
+static const int32_t statusNone   = 0;
+static const int32_t statusDevice = 1;
+static const int32_t statusDriver = 2;
+static const int32_t statusRecord = 3;
+
+static const int32_t severityInvalid = 3;
+
+// Row refresh deadbands - same as the DOSE_MONITOR and DOSE_RATE_MONITOR MDEL.
+//
+static const double doseDeadband = 0.0001;      // uSv
+static const double doseRateDeadband = 0.001;   // uSv/Hr
+
+// The device's own alarm flags, as opposed to the driver's threshold checks.
+//
+static const int deviceReasons = DriverLudlumM375::ReasonDeviceAlarm1 |
+                                 DriverLudlumM375::ReasonDeviceAlarm2 |
+                                 DriverLudlumM375::ReasonOverRange;
+
+//==============================================================================
+//
+class LudlumM375Publisher {
+public:
+   explicit LudlumM375Publisher (const char* pvName, const double period);
+
+   void start ();
+
+private:
+   const char* const pvName;
+   const double period;
+   pvxs::server::SharedPV pv;
+   volatile bool shutdownRequested;
+
+   // Last posted column values.
+   //
+   shared_array<const std::string> lastPort;
+   shared_array<const double>      lastDose;
+   shared_array<const double>      lastDoseRate;
+   shared_array<const int32_t>     lastCount;
+   shared_array<const int64_t>     lastSeconds;
+   shared_array<const int32_t>     lastNanoseconds;
+   shared_array<const int32_t>     lastSeverity;
+   shared_array<const int32_t>     lastStatus;
+   shared_array<const std::string> lastMessage;
+   int32_t lastMaxSeverity;
+   int32_t lastMaxStatus;
+   std::string lastMaxMessage;
+
+   void update ();
+   void threadFunction ();
+
+   static std::string alarmMessage (const DriverLudlumM375::Snapshot& snapshot);
+   static void classThreadFunction (void* parm);
+   static void classShutdown (void* arg);
+};
+
+//------------------------------------------------------------------------------
+// Sets the field in delta if and only if the column has changed since the
+// last post. Returns true if changed.
+//
+template <typename T>
+static bool markIfChanged (Value& delta, const char* field,
+                           shared_array<T>& column,
+                           shared_array<const T>& last)
+{
+   shared_array<const T> data (column.freeze ());
+
+   if ((data.size () == last.size ()) &&
+       std::equal (data.begin (), data.end (), last.begin ())) {
+      return false;
+   }
+
+   delta [field] = data;
+   last = data;
+   return true;
+}
+
+//------------------------------------------------------------------------------
+//
+LudlumM375Publisher::LudlumM375Publisher (const char* pvNameIn, const double periodIn) :
+   pvName (epicsStrDup (pvNameIn)),
+   period (periodIn),
+   pv (pvxs::server::SharedPV::buildReadonly ()),
+   shutdownRequested (false),
+   lastMaxSeverity (-1),
+   lastMaxStatus (-1)
+{
+}
+
+//------------------------------------------------------------------------------
+// Called once the IOC is running, i.e. when all drivers have been configured.
+//
+void LudlumM375Publisher::start ()
+{
+   try {
+      Value initial = pvxs::nt::NTTable {}
+            .add_column (TypeCode::String,  "port",             "Port")
+            .add_column (TypeCode::Float64, "dose",             "Dose (uSv)")
+            .add_column (TypeCode::Float64, "doseRate",         "Dose Rate (uSv/Hr)")
+            .add_column (TypeCode::Int32,   "count",            "Update Count")
+            .add_column (TypeCode::Int64,   "secondsPastEpoch", "Seconds")
+            .add_column (TypeCode::Int32,   "nanoseconds",      "Nanoseconds")
+            .add_column (TypeCode::Int32,   "severity",         "Severity")
+            .add_column (TypeCode::Int32,   "status",           "Status")
+            .add_column (TypeCode::String,  "message",          "Message")
+            .create ();
+
+      initial ["descriptor"] = "Ludlum M375 radiation monitors";
+
+      this->pv.open (initial);
+      pvxs::ioc::server ().addPV (this->pvName, this->pv);
+
+   } catch (std::exception& e) {
+      errlogPrintf ("LudlumM375Publisher: %s cannot create PV: %s\n",
+                    this->pvName, e.what ());
+      return;
+   }
+
+   char threadName [80];
+   snprintf (threadName, sizeof (threadName), "LudlumM375Pva_%s", this->pvName);
+
+   epicsThreadMustCreate (threadName, epicsThreadPriorityLow,
+                          epicsThreadGetStackSize (epicsThreadStackMedium),
+                          LudlumM375Publisher::classThreadFunction, this);
+
+   epicsAtExit (LudlumM375Publisher::classShutdown, this);
+}
+
+//------------------------------------------------------------------------------
+//
+void LudlumM375Publisher::update ()
+{
+   const int n = DriverLudlumM375::numberOfInstances ();
+
+   shared_array<std::string> port (n);
+   shared_array<double>      dose (n);
+   shared_array<double>      doseRate (n);
+   shared_array<int32_t>     count (n);
+   shared_array<int64_t>     seconds (n);
+   shared_array<int32_t>     nanoseconds (n);
+   shared_array<int32_t>     severity (n);
+   shared_array<int32_t>     status (n);
+   shared_array<std::string> message (n);
+
+   int32_t maxSeverity = 0;
+   int32_t maxStatus = statusNone;
+   std::string maxMessage;
+
+   for (int j = 0; j < n; j++) {
+      DriverLudlumM375* driver = DriverLudlumM375::getInstance (j);
+      DriverLudlumM375::Snapshot snapshot;
+      driver->getSnapshot (snapshot);
+
+      port [j] = driver->portName;
+
+      // Device alarm flags are a device alarm, threshold trips are akin to
+      // record limit alarms.
+      //
+      if (!snapshot.isValid) {
+         severity [j] = severityInvalid;
+         status [j] = statusDriver;
+      } else if (snapshot.alarmSeverity == 0) {
+         severity [j] = 0;
+         status [j] = statusNone;
+      } else {
+         severity [j] = snapshot.alarmSeverity;
+         status [j] = (snapshot.alarmReason & deviceReasons) ? statusDevice : statusRecord;
+      }
+      message [j] = this->alarmMessage (snapshot);
+
+      // Refresh the row values only if significantly changed, or new, or the
+      // alarm state has changed.
+      //
+      const bool isNewRow = (size_t) j >= this->lastDose.size ();
+      const bool refresh = isNewRow ||
+            (ABS (snapshot.dose - this->lastDose [j]) > doseDeadband) ||
+            (ABS (snapshot.doseRate - this->lastDoseRate [j]) > doseRateDeadband) ||
+            (severity [j] != this->lastSeverity [j]) ||
+            (status [j] != this->lastStatus [j]) ||
+            (message [j] != this->lastMessage [j]);
+
+      if (refresh) {
+         dose [j] = snapshot.dose;
+         doseRate [j] = snapshot.doseRate;
+         count [j] = snapshot.count;
+
+         // Rows that have never received a sample get a zero time stamp.
+         //
+         if (snapshot.hasSample) {
+            seconds [j] = int64_t (snapshot.readTime.secPastEpoch) + POSIX_TIME_AT_EPICS_EPOCH;
+            nanoseconds [j] = int32_t (snapshot.readTime.nsec);
+         } else {
+            seconds [j] = 0;
+            nanoseconds [j] = 0;
+         }
+      } else {
+         dose [j] = this->lastDose [j];
+         doseRate [j] = this->lastDoseRate [j];
+         count [j] = this->lastCount [j];
+         seconds [j] = this->lastSeconds [j];
+         nanoseconds [j] = this->lastNanoseconds [j];
+      }
+
+      // The table alarm is that of the (first) row with the highest severity.
+      //
+      if (severity [j] > maxSeverity) {
+         maxSeverity = severity [j];
+         maxStatus = status [j];
+         maxMessage = std::string (driver->portName) + ": " + message [j];
+      }
+   }
+
+   Value delta = this->pv.fetch ().cloneEmpty ();
+   bool changed = false;
+
+   changed |= markIfChanged (delta, "value.port",             port,        this->lastPort);
+   changed |= markIfChanged (delta, "value.dose",             dose,        this->lastDose);
+   changed |= markIfChanged (delta, "value.doseRate",         doseRate,    this->lastDoseRate);
+   changed |= markIfChanged (delta, "value.count",            count,       this->lastCount);
+   changed |= markIfChanged (delta, "value.secondsPastEpoch", seconds,     this->lastSeconds);
+   changed |= markIfChanged (delta, "value.nanoseconds",      nanoseconds, this->lastNanoseconds);
+   changed |= markIfChanged (delta, "value.severity",         severity,    this->lastSeverity);
+   changed |= markIfChanged (delta, "value.status",           status,      this->lastStatus);
+   changed |= markIfChanged (delta, "value.message",          message,     this->lastMessage);
+
+   if ((maxSeverity != this->lastMaxSeverity) ||
+       (maxStatus != this->lastMaxStatus) ||
+       (maxMessage != this->lastMaxMessage)) {
+      delta ["alarm.severity"] = maxSeverity;
+      delta ["alarm.status"] = maxStatus;
+      delta ["alarm.message"] = maxMessage;
+      this->lastMaxSeverity = maxSeverity;
+      this->lastMaxStatus = maxStatus;
+      this->lastMaxMessage = maxMessage;
+      changed = true;
+   }
+
+   if (!changed) return;
+
+   epicsTimeStamp timeNow = epicsTime::getCurrent ();
+   delta ["timeStamp.secondsPastEpoch"] = int64_t (timeNow.secPastEpoch) + POSIX_TIME_AT_EPICS_EPOCH;
+   delta ["timeStamp.nanoseconds"] = int32_t (timeNow.nsec);
+
+   this->pv.post (delta);
+}
+
+//------------------------------------------------------------------------------
+//
+void LudlumM375Publisher::threadFunction ()
+{
+   while (!this->shutdownRequested) {
+      try {
+         this->update ();
+      } catch (std::exception& e) {
+         errlogPrintf ("LudlumM375Publisher: %s update failed: %s\n",
+                       this->pvName, e.what ());
+      }
+      epicsThreadSleep (this->period);
+   }
+}
+
+//------------------------------------------------------------------------------
+// static
+std::string LudlumM375Publisher::alarmMessage (const DriverLudlumM375::Snapshot& snapshot)
+{
+   static const struct {
+      int bit;
+      const char* text;
+   } reasonList [] = {
+      { DriverLudlumM375::ReasonHiHi,         "HiHi"          },
+      { DriverLudlumM375::ReasonHigh,         "High"          },
+      { DriverLudlumM375::ReasonRateOfChange, "Rate of change"},
+      { DriverLudlumM375::ReasonStep,         "Step"          },
+      { DriverLudlumM375::ReasonDeviceAlarm1, "Alarm1"        },
+      { DriverLudlumM375::ReasonDeviceAlarm2, "Alarm2"        },
+      { DriverLudlumM375::ReasonOverRange,    "Over range"    }
+   };
+
+   if (!snapshot.isValid) return "Stale";
+
+   std::string result;
+   for (size_t j = 0; j < sizeof (reasonList) / sizeof (reasonList [0]); j++) {
+      if (snapshot.alarmReason & reasonList [j].bit) {
+         if (!result.empty ()) result += ", ";
+         result += reasonList [j].text;
+      }
+   }
+   return result;
+}
+
+//------------------------------------------------------------------------------
+// static
+void LudlumM375Publisher::classThreadFunction (void* parm)
+{
+   if (parm) {
+      LudlumM375Publisher* self = (LudlumM375Publisher*) parm;
+      self->threadFunction ();
+   }
+}
+
+//------------------------------------------------------------------------------
+// static
+void LudlumM375Publisher::classShutdown (void* arg)
+{
+   if (arg) {
+      LudlumM375Publisher* self = (LudlumM375Publisher*) arg;
+      self->shutdownRequested = true;
+   }
+}
+
+
+//==============================================================================
+// IOC shell commands
+//==============================================================================
+//
+static LudlumM375Publisher* publisher = NULL;
+
+//------------------------------------------------------------------------------
+//
+static void publisherInitHook (initHookState state)
+{
+   if ((state == initHookAfterIocRunning) && publisher) {
+      publisher->start ();
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+static const iocshArg PvaConfigureArg0 = { "Table PV name", iocshArgString };
+static const iocshArg PvaConfigureArg1 = { "Update period (sec)", iocshArgDouble };
+
+static const iocshArg *const LudlumM375PvaConfigureArgs[2] = {
+   &PvaConfigureArg0,
+   &PvaConfigureArg1
+};
+
+static const iocshFuncDef LudlumM375PvaConfigureFuncDef = {
+   "Ludlum_M375_PvaConfigure", 2, LudlumM375PvaConfigureArgs
+};
+
+//------------------------------------------------------------------------------
+//
+static void callLudlumM375PvaConfigure (const iocshArgBuf* args)
+{
+   // Do a basic validation.
+   //
+   if ((args[0].sval == NULL) || (strlen (args[0].sval) == 0)) {
+      errlogPrintf ("Ludlum_M375_PvaConfigure: Null/empty PV name\n");
+      return;
+   }
+
+   if (publisher) {
+      errlogPrintf ("Ludlum_M375_PvaConfigure: already configured\n");
+      return;
+   }
+
+   // The device sends an update every two seconds, default to 1 second.
+   //
+   const double period = args[1].dval > 0.0 ? args[1].dval : 1.0;
+
+   publisher = new LudlumM375Publisher (args[0].sval, period);
+   initHookRegister (publisherInitHook);
+}
+
+//------------------------------------------------------------------------------
+//
+static void LudlumM375PvaStartup (void)
+{
+   iocshRegister (&LudlumM375PvaConfigureFuncDef, callLudlumM375PvaConfigure);
+}
+
+epicsExportRegistrar (LudlumM375PvaStartup);
+
+// end
@@ -47,6 +47,28 @@ drvAsynIPServerPortConfigure ("SR15NRM01_SERVER", "${SERVER_NAME}:50001", 1, 1,
 Ludlum_M375_Configure ("SR15GRM01", "SR15GRM01_SERVER")
 Ludlum_M375_Configure ("SR15NRM01", "SR15NRM01_SERVER")
 
+# Alternatively, when using the ludlum_m375_manage service and its
+# ludlum_m375_c2c relays, create client ports and drivers for all the relays
+# defined in the map file (same file as used by ludlum_m375_manage) in one go.
+# Here the IOC is the TCP/IP client, connecting to the ioc_host:ioc_port
+# address on which each relay listens - a host of "host" means this host.
+#
+# Aguments
+# 1 - the map file
+# 2 - port name prefix, default "M375_" - the IOC port number is appended,
+#     e.g. M375_4015 and its client port M375_4015_CLIENT
+# 3 - optional host name - overrides the IOC host name in the map file
+#
+# Ludlum_M375_MapConfigure ("/asp/config/m375_map", "M375_", "")
+
+# Optionally (if built with PVXS) publish all monitors as a single NTTable PV.
+#
+# Aguments
+# 1 - the table PV name
+# 2 - update period (sec), default 1.0
+#
+# Ludlum_M375_PvaConfigure ("SR00RAD01:MONITOR_TABLE", 1.0)
+
 ## Load record instances
 #
 dbLoadTemplate ("db/ludlum_m375_test.substitutions")